@@ -31,3 +31,10 @@ void swapCodes (GLubyte * c1, GLubyte * c2)
 
   tmp = *c1; *c1 = *c2; *c2 = tmp;
 }
+
+GLint lineClipCohSuth (wcPt2D winMin, wcPt2D winMax, wcPt2D * p1, wcPt2D * p2)
+{
+  noClipRecorder rec;
+
+  return (clipCohSuth (winMin, winMax, p1, p2, rec));
+}
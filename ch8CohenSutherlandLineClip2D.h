@@ -1,8 +1,13 @@
 #ifndef COHEN_SUTHERLAND_H
 #define COHEN_SUTHERLAND_H
 
+#ifdef __APPLE__
 #include <OpenGL/gl.h>
 #include <GLUT/glut.h>
+#else
+#include <GL/gl.h>
+#include <GL/glut.h>
+#endif
 
 // Define the point class
 class wcPt2D {
@@ -26,4 +31,71 @@ GLubyte encode(wcPt2D pt, wcPt2D winMin, wcPt2D winMax);
 void swapPts(wcPt2D *p1, wcPt2D *p2);
 void swapCodes(GLubyte *c1, GLubyte *c2);
 
+// Clip p1-p2 against the window without drawing; the clipped endpoints are
+// written back and the return value is nonzero if any part of the line is kept
+GLint lineClipCohSuth(wcPt2D winMin, wcPt2D winMax, wcPt2D *p1, wcPt2D *p2);
+
+// Step recorder for lineClipCohSuth, which records nothing
+struct noClipRecorder {
+    void clipped(GLint, bool, wcPt2D, GLubyte) {}
+};
+
+/*
+ * The Cohen-Sutherland loop shared by lineClipCohSuth and the clip tracer.
+ * After every edge clip it calls rec.clipped(edgeBitCode, swapped, p1, code2)
+ * with the edge's bit code, whether the endpoints were swapped first, the new
+ * p1 and the (post-swap) code of p2.
+ */
+template <class Recorder>
+GLint clipCohSuth(wcPt2D winMin, wcPt2D winMax, wcPt2D *p1, wcPt2D *p2, Recorder &rec)
+{
+    GLubyte code1, code2;
+    GLint done = false, plotLine = false;
+    GLfloat m = 0.0;
+
+    while (!done) {
+        code1 = encode(*p1, winMin, winMax);
+        code2 = encode(*p2, winMin, winMax);
+        if (accept(code1, code2)) {
+            done = true;
+            plotLine = true;
+        } else if (reject(code1, code2)) {
+            done = true;
+        } else {
+            // Label the endpoint outside the display window as p1
+            bool swapped = inside(code1);
+            if (swapped) {
+                swapPts(p1, p2);
+                swapCodes(&code1, &code2);
+            }
+            // Use slope m to find line-clipEdge intersection
+            if (p2->x != p1->x)
+                m = (p2->y - p1->y) / (p2->x - p1->x);
+            GLint edge;
+            if (code1 & winLeftBitCode) {
+                p1->y += (winMin.x - p1->x) * m;
+                p1->x = winMin.x;
+                edge = winLeftBitCode;
+            } else if (code1 & winRightBitCode) {
+                p1->y += (winMax.x - p1->x) * m;
+                p1->x = winMax.x;
+                edge = winRightBitCode;
+            } else if (code1 & winBottomBitCode) {
+                // Need to update p1.x for nonvertical lines only
+                if (p2->x != p1->x && m != 0)
+                    p1->x += (winMin.y - p1->y) / m;
+                p1->y = winMin.y;
+                edge = winBottomBitCode;
+            } else {
+                if (p2->x != p1->x && m != 0)
+                    p1->x += (winMax.y - p1->y) / m;
+                p1->y = winMax.y;
+                edge = winTopBitCode;
+            }
+            rec.clipped(edge, swapped, *p1, code2);
+        }
+    }
+    return plotLine;
+}
+
 #endif // COHEN_SUTHERLAND_H
@@ -0,0 +1,183 @@
+#include <cstdio>
+#include <vector>
+#include <sys/types.h>
+#include "clipTrace.h"
+
+// The segment table follows the header, and the steps follow the table
+static uint64_t stepsOffset(uint64_t numSegs) {
+    return sizeof(clipTraceHeader) + numSegs * sizeof(clipTraceSeg);
+}
+
+// Tracing
+
+// Step recorder for clipCohSuth that fills a fixed array of trace steps
+struct traceRecorder {
+    wcPt2D winMin, winMax;
+    clipTraceStep *steps;
+    GLubyte numSteps;
+    bool overflow;
+
+    void clipped(GLint edge, bool swapped, wcPt2D p1, GLubyte code2) {
+        if (numSteps == maxTraceSteps) {
+            overflow = true;
+            return;
+        }
+
+        clipTraceStep &step = steps[numSteps++];
+        step.x = p1.x;
+        step.y = p1.y;
+        step.code1 = encode(p1, winMin, winMax);
+        step.code2 = code2;
+        step.flags = swapped ? traceStepSwapped : 0;
+        switch (edge) {
+            case winLeftBitCode:   step.edge = traceEdgeLeft;   break;
+            case winRightBitCode:  step.edge = traceEdgeRight;  break;
+            case winBottomBitCode: step.edge = traceEdgeBottom; break;
+            default:               step.edge = traceEdgeTop;    break;
+        }
+    }
+};
+
+GLint traceClipCohSuth(wcPt2D winMin, wcPt2D winMax, wcPt2D *p1, wcPt2D *p2,
+                       clipTraceStep *steps, GLubyte *numSteps, bool *overflow) {
+    traceRecorder rec = {winMin, winMax, steps, 0, false};
+    GLint plotLine = clipCohSuth(winMin, winMax, p1, p2, rec);
+
+    *numSteps = rec.numSteps;
+    *overflow = rec.overflow;
+    return plotLine;
+}
+
+// Writing
+
+const size_t traceBufSize = 65536;  // Table entries and steps buffered between writes
+
+ClipTraceWriter::ClipTraceWriter()
+    : fp(nullptr), ok(false), header(), segsWritten(0), stepsWritten(0) {}
+
+ClipTraceWriter::~ClipTraceWriter() {
+    if (fp) fclose(fp);
+}
+
+bool ClipTraceWriter::open(const char *path, wcPt2D winMin, wcPt2D winMax, uint64_t numSegs) {
+    if (fp) fclose(fp);
+    fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    // The step count is only known at the end, so the header is rewritten then
+    header = {clipTraceMagic, clipTraceVersion, winMin, winMax, numSegs, 0};
+    segsWritten = stepsWritten = 0;
+    segBuf.clear();
+    stepBuf.clear();
+    segBuf.reserve(traceBufSize);
+    stepBuf.reserve(traceBufSize + maxTraceSteps);
+    ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    return ok;
+}
+
+// Write the buffered table entries and steps to their places in the file
+bool ClipTraceWriter::flush() {
+    if (ok && !segBuf.empty()) {
+        off_t pos = off_t(sizeof(clipTraceHeader) + segsWritten * sizeof(clipTraceSeg));
+        ok = fseeko(fp, pos, SEEK_SET) == 0 &&
+             fwrite(segBuf.data(), sizeof(clipTraceSeg), segBuf.size(), fp) == segBuf.size();
+        segsWritten += segBuf.size();
+    }
+    if (ok && !stepBuf.empty()) {
+        off_t pos = off_t(stepsOffset(header.numSegs) + stepsWritten * sizeof(clipTraceStep));
+        ok = fseeko(fp, pos, SEEK_SET) == 0 &&
+             fwrite(stepBuf.data(), sizeof(clipTraceStep), stepBuf.size(), fp) == stepBuf.size();
+        stepsWritten += stepBuf.size();
+    }
+    segBuf.clear();
+    stepBuf.clear();
+    return ok;
+}
+
+bool ClipTraceWriter::add(const wcSeg2D *segs, size_t numSegs) {
+    if (segsWritten + segBuf.size() + numSegs > header.numSegs) ok = false;
+
+    for (size_t i = 0; ok && i < numSegs; i++) {
+        clipTraceSeg entry = {};
+        wcPt2D p1 = segs[i].p1, p2 = segs[i].p2;
+        clipTraceStep steps[maxTraceSteps];
+        bool overflow;
+
+        entry.seg = segs[i];
+        entry.firstStep = header.numSteps;
+        entry.code1 = encode(p1, header.winMin, header.winMax);
+        entry.code2 = encode(p2, header.winMin, header.winMax);
+        entry.accepted = GLubyte(traceClipCohSuth(header.winMin, header.winMax, &p1, &p2,
+                                                  steps, &entry.numSteps, &overflow));
+        entry.flags = overflow ? traceSegOverflow : 0;
+        segBuf.push_back(entry);
+
+        stepBuf.insert(stepBuf.end(), steps, steps + entry.numSteps);
+        header.numSteps += entry.numSteps;
+        if (segBuf.size() >= traceBufSize || stepBuf.size() >= traceBufSize) flush();
+    }
+    return ok;
+}
+
+bool ClipTraceWriter::finish() {
+    if (!fp) return false;
+    flush();
+
+    ok = ok && segsWritten == header.numSegs &&
+         fseeko(fp, 0, SEEK_SET) == 0 &&
+         fwrite(&header, sizeof(header), 1, fp) == 1;
+
+    if (fclose(fp) != 0) ok = false;
+    fp = nullptr;
+    return ok;
+}
+
+// Reading
+
+ClipTrace::ClipTrace() : header(nullptr), steps(nullptr), segTable(nullptr) {}
+
+ClipTrace::~ClipTrace() {
+    close();
+}
+
+bool ClipTrace::open(const char *path) {
+    close();
+    if (!map.open(path)) return false;
+
+    const char *base = map.data();
+    size_t mapSize = map.size();
+    const clipTraceHeader *hdr = reinterpret_cast<const clipTraceHeader *>(base);
+
+    // Validate the header and that both sections fit in the file. The counts
+    // are bounded by the file size first so the offset arithmetic cannot wrap.
+    if (mapSize < sizeof(clipTraceHeader) ||
+        hdr->magic != clipTraceMagic || hdr->version != clipTraceVersion ||
+        hdr->numSegs > mapSize / sizeof(clipTraceSeg) ||
+        hdr->numSteps > mapSize / sizeof(clipTraceStep) ||
+        stepsOffset(hdr->numSegs) + hdr->numSteps * sizeof(clipTraceStep) > mapSize) {
+        close();
+        return false;
+    }
+
+    // Replay trusts each segment's step range, so check all of them
+    const clipTraceSeg *table = reinterpret_cast<const clipTraceSeg *>(base + sizeof(clipTraceHeader));
+    for (uint64_t i = 0; i < hdr->numSegs; i++) {
+        if (table[i].numSteps > maxTraceSteps || table[i].firstStep > hdr->numSteps ||
+            table[i].numSteps > hdr->numSteps - table[i].firstStep) {
+            close();
+            return false;
+        }
+    }
+
+    header = hdr;
+    segTable = table;
+    steps = reinterpret_cast<const clipTraceStep *>(base + size_t(stepsOffset(hdr->numSegs)));
+    return true;
+}
+
+void ClipTrace::close() {
+    map.close();
+    header = nullptr;
+    steps = nullptr;
+    segTable = nullptr;
+}
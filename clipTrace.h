@@ -0,0 +1,126 @@
+#ifndef CLIP_TRACE_H
+#define CLIP_TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+#include "segmentFile.h"
+#include "mappedFile.h"
+
+/*
+ * Binary clip trace. Records every edge clip the Cohen-Sutherland loop makes
+ * so the step animation can be replayed without recomputing it:
+ *
+ *   clipTraceHeader
+ *   numSegs clipTraceSeg       (segment table indexing into the steps)
+ *   numSteps clipTraceStep     (fixed width, grouped by segment)
+ *
+ * The segment count is known up front, so the steps start at a fixed offset
+ * and both sections can be written as segments are traced.
+ */
+const uint32_t clipTraceMagic = 0x43525443;   // "CTRC" in little-endian order
+const uint32_t clipTraceVersion = 2;
+
+// Edge codes stored in clipTraceStep::edge, in the order of mmn13's ClipEdge
+const GLubyte traceEdgeNone = 0;
+const GLubyte traceEdgeLeft = 1;
+const GLubyte traceEdgeRight = 2;
+const GLubyte traceEdgeBottom = 3;
+const GLubyte traceEdgeTop = 4;
+
+// clipTraceStep::flags
+const GLubyte traceStepSwapped = 0x1;   // Endpoints were swapped before this clip
+
+// clipTraceSeg::flags
+const GLubyte traceSegOverflow = 0x1;   // More than maxTraceSteps clips; steps truncated
+
+// Steps recorded per segment; Cohen-Sutherland clips each endpoint at most twice
+const int maxTraceSteps = 4;
+
+struct clipTraceHeader {
+    uint32_t magic;
+    uint32_t version;
+    wcPt2D winMin, winMax;
+    uint64_t numSegs;
+    uint64_t numSteps;
+};
+
+// One edge clip: the new p1 and the region codes after clipping
+struct clipTraceStep {
+    GLfloat x, y;
+    GLubyte code1, code2;
+    GLubyte edge;
+    GLubyte flags;
+};
+
+// Segment table entry: original endpoints and where its steps are
+struct clipTraceSeg {
+    wcSeg2D seg;
+    uint64_t firstStep;
+    GLubyte numSteps;
+    GLubyte accepted;
+    GLubyte code1, code2;   // Region codes of the original endpoints
+    GLubyte flags;
+    GLubyte pad[3];
+};
+
+// Clip p1-p2 with the same loop as lineClipCohSuth, recording up to
+// maxTraceSteps edge clips into steps. numSteps receives the recorded count
+// and overflow is set if the loop clipped more often than that.
+GLint traceClipCohSuth(wcPt2D winMin, wcPt2D winMax, wcPt2D *p1, wcPt2D *p2,
+                       clipTraceStep *steps, GLubyte *numSteps, bool *overflow);
+
+// Streams a trace of numSegs segments to disk in fixed-size buffers, so memory
+// use does not grow with the segment count. Segments may be added in any
+// number of batches, but exactly numSegs of them before finish().
+class ClipTraceWriter {
+public:
+    ClipTraceWriter();
+    ~ClipTraceWriter();
+
+    bool open(const char *path, wcPt2D winMin, wcPt2D winMax, uint64_t numSegs);
+    bool add(const wcSeg2D *segs, size_t numSegs);
+    bool finish();   // Writes the final header, then closes
+
+private:
+    ClipTraceWriter(const ClipTraceWriter &) = delete;
+    ClipTraceWriter &operator=(const ClipTraceWriter &) = delete;
+
+    bool flush();
+
+    FILE *fp;
+    bool ok;
+    clipTraceHeader header;
+    uint64_t segsWritten;   // Table entries already on disk
+    uint64_t stepsWritten;  // Steps already on disk
+    std::vector<clipTraceSeg> segBuf;
+    std::vector<clipTraceStep> stepBuf;
+};
+
+// Read-only, memory-mapped view of a clip trace
+class ClipTrace {
+public:
+    ClipTrace();
+    ~ClipTrace();
+
+    bool open(const char *path);
+    void close();
+
+    uint64_t numSegs() const { return header ? header->numSegs : 0; }
+    wcPt2D winMin() const { return header ? header->winMin : wcPt2D(); }
+    wcPt2D winMax() const { return header ? header->winMax : wcPt2D(); }
+    const clipTraceSeg &seg(uint64_t i) const { return segTable[i]; }
+    const clipTraceStep *segSteps(uint64_t i) const { return steps + segTable[i].firstStep; }
+
+private:
+    ClipTrace(const ClipTrace &) = delete;
+    ClipTrace &operator=(const ClipTrace &) = delete;
+
+    MappedFile map;
+    const clipTraceHeader *header;
+    const clipTraceStep *steps;
+    const clipTraceSeg *segTable;
+};
+
+#endif // CLIP_TRACE_H
@@ -0,0 +1,128 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include "clipTrace.h"
+
+// Read a whole file into bytes
+static std::vector<char> readBytes(const char *path) {
+    std::vector<char> bytes;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return bytes;
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        bytes.insert(bytes.end(), buf, buf + n);
+    fclose(fp);
+    return bytes;
+}
+
+// Write bytes to path and report whether ClipTrace accepts the result
+static bool opensAfterWrite(const std::string &path, const std::vector<char> &bytes) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    fwrite(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+
+    ClipTrace trace;
+    bool opened = trace.open(path.c_str());
+    remove(path.c_str());
+    return opened;
+}
+
+// Report a failed check and pass its result through
+static bool check(bool ok, const char *what) {
+    if (!ok) fprintf(stderr, "FAILED: %s\n", what);
+    return ok;
+}
+
+/*
+ * Headless check of the clip trace: every entry's verdict and final endpoint
+ * must match lineClipCohSuth(), and open() must refuse damaged traces.
+ * argv[1] is a scratch path.
+ */
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s SCRATCH_PATH\n", argv[0]);
+        return 1;
+    }
+    std::string path = argv[1];
+    bool ok = true;
+
+    const wcPt2D winMin = {50.0f, 50.0f}, winMax = {150.0f, 150.0f};
+    std::vector<wcSeg2D> segs;
+    generateRandomSegs(segs, 200000, {0.0f, 0.0f}, {225.0f, 225.0f});
+
+    // Uneven batches so buffer flushes fall in the middle of a batch
+    ClipTraceWriter writer;
+    ok = check(writer.open(path.c_str(), winMin, winMax, segs.size()) &&
+               writer.add(segs.data(), 1000) &&
+               writer.add(segs.data() + 1000, 99000) &&
+               writer.add(segs.data() + 100000, segs.size() - 100000) &&
+               writer.finish(), "write trace") && ok;
+
+    ClipTrace trace;
+    ok = check(trace.open(path.c_str()), "open trace") && ok;
+    ok = check(trace.numSegs() == segs.size(), "segment count") && ok;
+
+    uint64_t mismatches = 0, withSteps = 0;
+    for (uint64_t i = 0; i < trace.numSegs(); i++) {
+        const clipTraceSeg &entry = trace.seg(i);
+        wcSeg2D seg = segs[i];
+        GLint accepted = lineClipCohSuth(winMin, winMax, &seg.p1, &seg.p2);
+
+        bool same = memcmp(&entry.seg, &segs[i], sizeof(wcSeg2D)) == 0 &&
+                    entry.accepted == accepted && !(entry.flags & traceSegOverflow);
+        if (same && accepted) {
+            // The last recorded clip is the final position of p1
+            wcPt2D last = entry.numSteps ? wcPt2D{trace.segSteps(i)[entry.numSteps - 1].x,
+                                                  trace.segSteps(i)[entry.numSteps - 1].y}
+                                         : segs[i].p1;
+            same = last.x == seg.p1.x && last.y == seg.p1.y;
+        }
+        mismatches += !same;
+        withSteps += entry.numSteps > 0;
+    }
+    ok = check(mismatches == 0, "trace matches lineClipCohSuth") && ok;
+    ok = check(withSteps > 0, "trace records clip steps") && ok;
+    trace.close();
+
+    // A writer given fewer segments than announced must fail
+    ClipTraceWriter shortWriter;
+    std::string shortPath = path + ".short";
+    ok = check(shortWriter.open(shortPath.c_str(), winMin, winMax, 10) &&
+               shortWriter.add(segs.data(), 9) && !shortWriter.finish(),
+               "refuse to finish a short trace") && ok;
+    remove(shortPath.c_str());
+
+    // Damaged copies of the trace must be refused
+    std::vector<char> bytes = readBytes(path.c_str());
+    std::string bad = path + ".bad";
+    uint64_t stepped = 0;
+    ClipTrace reread;
+    reread.open(path.c_str());
+    while (stepped < reread.numSegs() && reread.seg(stepped).numSteps == 0) stepped++;
+    reread.close();
+    size_t entryOffset = sizeof(clipTraceHeader) + size_t(stepped) * sizeof(clipTraceSeg);
+
+    std::vector<char> damaged(bytes.begin(), bytes.end() - sizeof(clipTraceStep));
+    ok = check(!opensAfterWrite(bad, damaged), "refuse truncated trace") && ok;
+
+    damaged = bytes;
+    uint64_t numSteps;
+    memcpy(&numSteps, &bytes[offsetof(clipTraceHeader, numSteps)], sizeof(numSteps));
+    memcpy(&damaged[entryOffset + offsetof(clipTraceSeg, firstStep)], &numSteps, sizeof(numSteps));
+    ok = check(!opensAfterWrite(bad, damaged), "refuse firstStep past the steps") && ok;
+
+    damaged = bytes;
+    damaged[entryOffset + offsetof(clipTraceSeg, numSteps)] = maxTraceSteps + 1;
+    ok = check(!opensAfterWrite(bad, damaged), "refuse numSteps above maxTraceSteps") && ok;
+
+    ok = check(opensAfterWrite(bad, bytes), "reopen undamaged copy") && ok;
+    remove(path.c_str());
+
+    printf("%s: %lu segments, %llu with clip steps\n", ok ? "OK" : "FAILED",
+           (unsigned long)segs.size(), (unsigned long long)withSteps);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "clipTrace.h"
+
+// Print command-line usage
+void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s (--segments FILE | --random N [--world XMIN YMIN XMAX YMAX] [--save-segments FILE])\n"
+            "          [--window XMIN YMIN XMAX YMAX] [-o TRACE]\n"
+            "  --segments FILE  trace the segments of a segment file\n"
+            "  --random N       trace N random segments, as generated by the demo's --stress N\n"
+            "  --world ...      area the random segments start in (default 0 0 225 225)\n"
+            "  --save-segments FILE\n"
+            "                   sort the random segments spatially and write them as a\n"
+            "                   segment file, for --stress-file or --segments\n"
+            "  --window ...     clipping window (default 50 50 150 150, as in the demo)\n"
+            "  -o TRACE         output trace file, replayed with --replay in the demo\n", prog);
+}
+
+/*
+ * Headless clip-trace generator - records every clip step of every segment
+ * without any GL calls, so whole datasets can be audited offline.
+ */
+int main(int argc, char **argv) {
+    const char *segPath = nullptr;
+    const char *outPath = nullptr;
+    const char *savePath = nullptr;
+    unsigned long numRandom = 0;
+    wcPt2D winMin = {50.0, 50.0}, winMax = {150.0, 150.0};
+    wcPt2D worldMin = {0.0, 0.0}, worldMax = {225.0, 225.0};
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--segments") && i + 1 < argc) {
+            segPath = argv[++i];
+        } else if (!strcmp(argv[i], "--random") && i + 1 < argc) {
+            numRandom = strtoul(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--window") && i + 4 < argc) {
+            winMin.x = GLfloat(atof(argv[++i]));
+            winMin.y = GLfloat(atof(argv[++i]));
+            winMax.x = GLfloat(atof(argv[++i]));
+            winMax.y = GLfloat(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--world") && i + 4 < argc) {
+            worldMin.x = GLfloat(atof(argv[++i]));
+            worldMin.y = GLfloat(atof(argv[++i]));
+            worldMax.x = GLfloat(atof(argv[++i]));
+            worldMax.y = GLfloat(atof(argv[++i]));
+        } else if (!strcmp(argv[i], "--save-segments") && i + 1 < argc) {
+            savePath = argv[++i];
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!(outPath || savePath) || (!segPath && numRandom == 0) || (segPath && savePath)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    SegmentFile file;
+    std::vector<wcSeg2D> randomSegs;
+    if (segPath) {
+        if (!file.open(segPath)) {
+            fprintf(stderr, "Cannot open segment file %s\n", segPath);
+            return 1;
+        }
+    } else {
+        generateRandomSegs(randomSegs, numRandom, worldMin, worldMax);
+    }
+
+    if (savePath) {
+        // The trace below then follows the same order as the saved file
+        sortSegsSpatially(randomSegs);
+        if (!writeSegmentFile(savePath, randomSegs.data(), randomSegs.size())) {
+            fprintf(stderr, "Cannot write segment file %s\n", savePath);
+            return 1;
+        }
+        printf("Wrote %lu segments to %s\n", (unsigned long)randomSegs.size(), savePath);
+    }
+    if (!outPath) return 0;
+
+    ClipTraceWriter writer;
+    uint64_t numSegs = segPath ? file.numSegs() : randomSegs.size();
+    if (!writer.open(outPath, winMin, winMax, numSegs)) {
+        fprintf(stderr, "Cannot write trace %s\n", outPath);
+        return 1;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool ok = true;
+    if (segPath) {
+        // Trace straight from the mapped blocks, without copying the file
+        for (uint32_t b = 0; ok && b < file.numBlocks(); b++)
+            ok = writer.add(file.blockSegs(b), file.blockHeader(b).count);
+    } else {
+        ok = writer.add(randomSegs.data(), randomSegs.size());
+    }
+
+    if (!writer.finish() || !ok) {
+        fprintf(stderr, "Cannot write trace %s\n", outPath);
+        return 1;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Traced %llu segments to %s in %.1f ms\n", (unsigned long long)numSegs, outPath, ms);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mappedFile.h"
+
+MappedFile::MappedFile() : base(nullptr), length(0) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const char *path) {
+    close();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    // Empty files cannot be mapped, and neither format allows them
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid after the descriptor is closed
+    if (mapped == MAP_FAILED) return false;
+
+    base = mapped;
+    length = size_t(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (base) munmap(base, length);
+    base = nullptr;
+    length = 0;
+}
+
+void MappedFile::adviseSequential(size_t offset, size_t bytes) const {
+    if (bytes == 0) return;
+    madvise(static_cast<char *>(base) + offset, bytes, MADV_SEQUENTIAL);
+    madvise(static_cast<char *>(base) + offset, bytes, MADV_WILLNEED);
+}
+
+void MappedFile::adviseRandom(size_t offset, size_t bytes) const {
+    if (bytes == 0) return;
+    madvise(static_cast<char *>(base) + offset, bytes, MADV_RANDOM);
+}
@@ -0,0 +1,30 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// Whole file mapped read-only into memory; shared by the segment and trace readers
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool open(const char *path);
+    void close();
+
+    const char *data() const { return static_cast<const char *>(base); }
+    size_t size() const { return length; }
+
+    // Access-pattern hints for part of the mapping; offset must be page aligned
+    void adviseSequential(size_t offset, size_t bytes) const;
+    void adviseRandom(size_t offset, size_t bytes) const;
+
+private:
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    void *base;
+    size_t length;
+};
+
+#endif // MAPPED_FILE_H
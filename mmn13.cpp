@@ -1,7 +1,13 @@
 #include <string>
+#include <vector>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "ch8CohenSutherlandLineClip2D.h"
+#include "segmentFile.h"
+#include "clipTrace.h"
 
 // Constants for animation and display
 const int ANIM_DELAY = 2000;    // Animation delay in milliseconds
@@ -59,6 +65,23 @@ ClipEdge currentEdge = ClipEdge::NONE;
 ClipEdge prevEdge = ClipEdge::NONE;
 ClipEdge eraseEdge = ClipEdge::NONE;
 
+// Stress mode: clip and draw many segments every frame and time each phase
+typedef std::chrono::steady_clock StressClock;
+bool stressMode = false;
+bool stressAutoPan = true;      // Pan the window on its own until the user drags it
+std::vector<wcSeg2D> stressSegs;    // Generated segments (unused when a file is loaded)
+SegmentFile stressFile;             // Segment file loaded with --stress-file
+std::vector<wcSeg2D> stressClipped; // Segments that survived this frame's clip
+FILE *stressLog = nullptr;      // Per-frame CSV log
+long stressFrame = 0;
+long stressFrameLimit = 0;      // Exit after this many frames (0 = run forever)
+double clipMs = 0.0, drawMs = 0.0, swapMs = 0.0;   // Timings of the last frame
+
+// Replay mode: animate segments from a clip trace instead of recomputing them
+ClipTrace replayTrace;
+uint64_t replaySeg = 0;         // Selected segment in the trace
+int replayStep = 0;             // Next trace step of the running animation
+
 // Function prototypes - organized for better readability
 void displayFcn(void);
 void animateClippingStep(void);
@@ -70,6 +93,7 @@ void init(void);
 void drawEdgeColorKey(void);
 void drawIdleStateContent(void);
 void drawAnimationStateContent(void);
+void drawStressStateContent(void);
 
 // Returns the edge name as a string - simplified with a switch statement
 const char* getEdgeName(ClipEdge edge) {
@@ -82,6 +106,17 @@ const char* getEdgeName(ClipEdge edge) {
     }
 }
 
+// Converts a trace edge code to the matching edge type
+ClipEdge edgeFromTrace(GLubyte edge) {
+    switch (edge) {
+        case traceEdgeLeft:   return ClipEdge::LEFT;
+        case traceEdgeRight:  return ClipEdge::RIGHT;
+        case traceEdgeBottom: return ClipEdge::BOTTOM;
+        case traceEdgeTop:    return ClipEdge::TOP;
+        default:              return ClipEdge::NONE;
+    }
+}
+
 // Sets color based on edge type - consolidated into a function
 void setColorForEdge(ClipEdge edge) {
     switch (edge) {
@@ -292,6 +327,7 @@ void startAnimation() {
     // Calculate initial codes using the function from the header
     code1 = encode(curr_p1, winMin, winMax);
     code2 = encode(curr_p2, winMin, winMax);
+    replayStep = 0;
 
     statusMsg = "Animation started...";
 
@@ -299,6 +335,43 @@ void startAnimation() {
     glutTimerFunc(ANIM_DELAY, timerFunc, 0);
 }
 
+// Select a trace segment for replay; its endpoints and window become current
+void selectReplaySeg(uint64_t i) {
+    replaySeg = i;
+    p1 = replayTrace.seg(i).seg.p1;
+    p2 = replayTrace.seg(i).seg.p2;
+    winMin = replayTrace.winMin();
+    winMax = replayTrace.winMax();
+}
+
+// Apply the next recorded clip of the replayed segment
+void replayClipStep() {
+    const clipTraceSeg &entry = replayTrace.seg(replaySeg);
+    currentEdge = ClipEdge::NONE;
+
+    // Out of recorded steps while the codes still call for clipping (a
+    // truncated or damaged trace) - finish with the trace's own verdict.
+    // The current endpoints are only partly clipped, so no final line is
+    // drawn even if the segment was accepted.
+    if (replayStep >= entry.numSteps) {
+        done = true;
+        plotLine = false;
+        showColoredLines = false;
+        statusMsg = std::string("Trace ends here") +
+                    ((entry.flags & traceSegOverflow) ? " (step limit reached)" : "") +
+                    (entry.accepted ? " - recorded result: ACCEPTED" : " - recorded result: REJECTED");
+        return;
+    }
+
+    const clipTraceStep &step = replayTrace.segSteps(replaySeg)[replayStep++];
+    curr_p1.x = step.x;
+    curr_p1.y = step.y;
+    code1 = step.code1;
+    code2 = step.code2;
+    currentEdge = edgeFromTrace(step.edge);
+    statusMsg = std::string("Clipped against ") + getEdgeName(currentEdge) + " edge of window (replayed)";
+}
+
 // Perform one step of the Cohen-Sutherland algorithm
 void animateClippingStep() {
     if (done) return;
@@ -347,8 +420,18 @@ void animateClippingStep() {
         // Set swapInProgress to true when we're in this step
         swapInProgress = true;
 
-        // Use inside function from header
-        if (inside(code1)) {
+        // When replaying, the trace says whether the algorithm swapped here
+        bool swapNeeded;
+        if (replayTrace.numSegs() > 0) {
+            const clipTraceSeg &entry = replayTrace.seg(replaySeg);
+            swapNeeded = replayStep < entry.numSteps &&
+                         (replayTrace.segSteps(replaySeg)[replayStep].flags & traceStepSwapped);
+        } else {
+            // Use inside function from header
+            swapNeeded = inside(code1);
+        }
+
+        if (swapNeeded) {
             // Use swap functions from header
             swapPts(&curr_p1, &curr_p2);
             swapCodes(&code1, &code2);
@@ -365,38 +448,46 @@ void animateClippingStep() {
     // Clear the swapInProgress flag for clipping steps
     swapInProgress = false;
 
-    // Calculate line slope
-    if (curr_p2.x != curr_p1.x)
-        m = (curr_p2.y - curr_p1.y) / (curr_p2.x - curr_p1.x);
-    else
-        m = 1000000.0; // Large value for nearly vertical lines
-
-    // Reset current edge
-    currentEdge = ClipEdge::NONE;
+    if (replayTrace.numSegs() > 0) {
+        // Take the clip from the trace instead of recomputing it
+        replayClipStep();
+    } else {
+        // Calculate line slope
+        if (curr_p2.x != curr_p1.x)
+            m = (curr_p2.y - curr_p1.y) / (curr_p2.x - curr_p1.x);
+        else
+            m = 1000000.0; // Large value for nearly vertical lines
+
+        // Reset current edge
+        currentEdge = ClipEdge::NONE;
+
+        // Clip against the appropriate edge
+        if (code1 & winLeftBitCode) {
+            curr_p1.y += (winMin.x - curr_p1.x) * m;
+            curr_p1.x = winMin.x;
+            currentEdge = ClipEdge::LEFT;
+            statusMsg = "Clipped against LEFT edge of window";
+        } else if (code1 & winRightBitCode) {
+            curr_p1.y += (winMax.x - curr_p1.x) * m;
+            curr_p1.x = winMax.x;
+            currentEdge = ClipEdge::RIGHT;
+            statusMsg = "Clipped against RIGHT edge of window";
+        } else if (code1 & winBottomBitCode) {
+            if (curr_p2.x != curr_p1.x && m != 0) // Avoid division by zero or undefined slope
+                curr_p1.x += (winMin.y - curr_p1.y) / m;
+            curr_p1.y = winMin.y;
+            currentEdge = ClipEdge::BOTTOM;
+            statusMsg = "Clipped against BOTTOM edge of window";
+        } else if (code1 & winTopBitCode) {
+            if (curr_p2.x != curr_p1.x && m != 0) // Avoid division by zero or undefined slope
+                curr_p1.x += (winMax.y - curr_p1.y) / m;
+            curr_p1.y = winMax.y;
+            currentEdge = ClipEdge::TOP;
+            statusMsg = "Clipped against TOP edge of window";
+        }
 
-    // Clip against the appropriate edge
-    if (code1 & winLeftBitCode) {
-        curr_p1.y += (winMin.x - curr_p1.x) * m;
-        curr_p1.x = winMin.x;
-        currentEdge = ClipEdge::LEFT;
-        statusMsg = "Clipped against LEFT edge of window";
-    } else if (code1 & winRightBitCode) {
-        curr_p1.y += (winMax.x - curr_p1.x) * m;
-        curr_p1.x = winMax.x;
-        currentEdge = ClipEdge::RIGHT;
-        statusMsg = "Clipped against RIGHT edge of window";
-    } else if (code1 & winBottomBitCode) {
-        if (curr_p2.x != curr_p1.x && m != 0) // Avoid division by zero or undefined slope
-            curr_p1.x += (winMin.y - curr_p1.y) / m;
-        curr_p1.y = winMin.y;
-        currentEdge = ClipEdge::BOTTOM;
-        statusMsg = "Clipped against BOTTOM edge of window";
-    } else if (code1 & winTopBitCode) {
-        if (curr_p2.x != curr_p1.x && m != 0) // Avoid division by zero or undefined slope
-            curr_p1.x += (winMax.y - curr_p1.y) / m;
-        curr_p1.y = winMax.y;
-        currentEdge = ClipEdge::TOP;
-        statusMsg = "Clipped against TOP edge of window";
+        // Recalculate code for new position using function from header
+        code1 = encode(curr_p1, winMin, winMax);
     }
 
     // If we clipped against an edge, show colored lines briefly
@@ -407,9 +498,6 @@ void animateClippingStep() {
         glutTimerFunc(ANIM_DELAY, coloredLinesTimer, 1);
     }
 
-    // Recalculate code for new position using function from header
-    code1 = encode(curr_p1, winMin, winMax);
-
     // Reset to step 0 to check for trivial conditions again
     animStep = 0;
 }
@@ -418,11 +506,23 @@ void animateClippingStep() {
 void displayFcn(void) {
     glClear(GL_COLOR_BUFFER_BIT);
 
+    if (stressMode) {
+        drawStressStateContent();
+        return;
+    }
+
     // Draw clipping window
     drawClippingWindow();
 
     // Draw instructions
-    drawText("Click and drag to move endpoints. Left button = P1, Right button = P2", 10, TEXT_BASE_Y);
+    if (replayTrace.numSegs() > 0) {
+        char replayInfo[120];
+        snprintf(replayInfo, sizeof(replayInfo), "Replaying trace segment %llu of %llu - press N/P to select",
+                 (unsigned long long)replaySeg + 1, (unsigned long long)replayTrace.numSegs());
+        drawText(replayInfo, 10, TEXT_BASE_Y);
+    } else {
+        drawText("Click and drag to move endpoints. Left button = P1, Right button = P2", 10, TEXT_BASE_Y);
+    }
     drawText("Press SPACE to start/reset animation", 10, TEXT_BASE_Y - 20);
 
     // Draw appropriate content based on animation state
@@ -531,6 +631,88 @@ void drawAnimationStateContent() {
     }
 }
 
+// Milliseconds elapsed between two clock readings
+double elapsedMs(StressClock::time_point start, StressClock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Callback for clipSegmentFile - keep a clipped segment for drawing
+void appendStressSeg(wcSeg2D seg, void *) {
+    stressClipped.push_back(seg);
+}
+
+// Clip every stress segment against the current window into stressClipped
+void clipStressSegs() {
+    stressClipped.clear();
+    if (stressFile.numBlocks() > 0) {
+        clipSegmentFile(stressFile, winMin, winMax, appendStressSeg, nullptr);
+        return;
+    }
+    for (size_t i = 0; i < stressSegs.size(); i++) {
+        wcSeg2D seg = stressSegs[i];
+        if (lineClipCohSuth(winMin, winMax, &seg.p1, &seg.p2))
+            appendStressSeg(seg, nullptr);
+    }
+}
+
+// Draw content in stress mode through the demo's own drawLine() path.
+// Draw time covers command submission only; the driver may defer the
+// actual rasterization until the buffer swap.
+void drawStressStateContent() {
+    StressClock::time_point t0 = StressClock::now();
+    clipStressSegs();
+    StressClock::time_point t1 = StressClock::now();
+
+    drawClippingWindow();
+
+    for (size_t i = 0; i < stressClipped.size(); i++) {
+        drawLine(stressClipped[i].p1, stressClipped[i].p2, COLOR_BLACK);
+    }
+
+    // Timings of the previous frame, since this frame's swap is still ahead
+    unsigned long long numSegs = stressFile.numBlocks() > 0 ?
+            stressFile.numSegs() : stressSegs.size();
+    char info[200];
+    snprintf(info, sizeof(info), "Stress: %llu segments, %lu visible - frame %ld",
+             numSegs, (unsigned long)stressClipped.size(), stressFrame);
+    drawText(info, 10, 30);
+    snprintf(info, sizeof(info), "clip %.2f ms  draw %.2f ms  swap %.2f ms",
+             clipMs, drawMs, swapMs);
+    drawText(info, 10, 10);
+    StressClock::time_point t2 = StressClock::now();
+
+    glutSwapBuffers();
+    StressClock::time_point t3 = StressClock::now();
+
+    clipMs = elapsedMs(t0, t1);
+    drawMs = elapsedMs(t1, t2);
+    swapMs = elapsedMs(t2, t3);
+
+    if (stressLog) {
+        fprintf(stressLog, "%ld,%llu,%lu,%.4f,%.4f,%.4f\n", stressFrame, numSegs,
+                (unsigned long)stressClipped.size(), clipMs, drawMs, swapMs);
+    }
+
+    stressFrame++;
+    if (stressFrameLimit > 0 && stressFrame >= stressFrameLimit) {
+        if (stressLog) fclose(stressLog);
+        exit(0);
+    }
+}
+
+// Idle callback in stress mode - keep redrawing, panning the window if idle
+void stressIdleFcn() {
+    if (stressAutoPan) {
+        GLfloat halfW = (winMax.x - winMin.x) / 2, halfH = (winMax.y - winMin.y) / 2;
+        GLfloat angle = stressFrame * 0.02f;
+        GLfloat cx = (xwcMin + xwcMax) / 2 + 50.0f * std::cos(angle);
+        GLfloat cy = (ywcMin + ywcMax) / 2 + 50.0f * std::sin(angle);
+        winMin = {cx - halfW, cy - halfH};
+        winMax = {cx + halfW, cy + halfH};
+    }
+    glutPostRedisplay();
+}
+
 // Draw color key for edges
 void drawEdgeColorKey() {
     drawText("Edge Color Key:", 10, TEXT_BASE_Y - 10);
@@ -571,6 +753,15 @@ void drawEdgeColorKey() {
 
 // Mouse callback
 void mouseFcn(int button, int state, int x, int y) {
+    // In stress mode a press hands the window over to dragging
+    if (stressMode) {
+        if (state == GLUT_DOWN) stressAutoPan = false;
+        return;
+    }
+
+    // Replayed endpoints come from the trace and cannot be edited
+    if (replayTrace.numSegs() > 0) return;
+
     // Only allow mouse interaction before animation or after it's done
     if (animState == AnimationState::RUNNING && !done) return;
 
@@ -605,12 +796,22 @@ void mouseFcn(int button, int state, int x, int y) {
 void motionFcn(int x, int y) {
     // Only allow mouse interaction before animation or after it's done
     if (animState == AnimationState::RUNNING && !done) return;
+    if (replayTrace.numSegs() > 0) return;
 
     // Convert screen coordinates to world coordinates
     wcPt2D movePt;
     movePt.x = static_cast<GLfloat>(x) * (xwcMax - xwcMin) / winWidth + xwcMin;
     movePt.y = static_cast<GLfloat>(winHeight - y) * (ywcMax - ywcMin) / winHeight + ywcMin;
 
+    // In stress mode, drag the clipping window centered on the mouse
+    if (stressMode) {
+        GLfloat halfW = (winMax.x - winMin.x) / 2, halfH = (winMax.y - winMin.y) / 2;
+        winMin = {movePt.x - halfW, movePt.y - halfH};
+        winMax = {movePt.x + halfW, movePt.y + halfH};
+        glutPostRedisplay();
+        return;
+    }
+
     // Determine which point is closer to the mouse position
     float d1 = std::abs(movePt.x - p1.x) + std::abs(movePt.y - p1.y);
     float d2 = std::abs(movePt.x - p2.x) + std::abs(movePt.y - p2.y);
@@ -628,6 +829,7 @@ void motionFcn(int x, int y) {
 void keyboardFcn(unsigned char key, int x, int y) {
     switch (key) {
         case ' ': // Start/reset animation
+            if (stressMode) break;
             if (animState == AnimationState::IDLE) {
                 startAnimation();
             } else {
@@ -638,6 +840,17 @@ void keyboardFcn(unsigned char key, int x, int y) {
             }
             glutPostRedisplay();
             break;
+        case 'n': // Next/previous trace segment in replay mode
+        case 'N':
+        case 'p':
+        case 'P':
+            if (replayTrace.numSegs() > 0 && animState == AnimationState::IDLE) {
+                uint64_t count = replayTrace.numSegs();
+                selectReplaySeg((key == 'n' || key == 'N') ? (replaySeg + 1) % count
+                                                           : (replaySeg + count - 1) % count);
+                glutPostRedisplay();
+            }
+            break;
         case 27: // Escape key
             exit(0);
             break;
@@ -650,7 +863,7 @@ void winReshapeFcn(GLint newWidth, GLint newHeight) {
 
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
-    gluOrtho2D(xwcMin, xwcMax, ywcMin, ywcMax);
+    glOrtho(xwcMin, xwcMax, ywcMin, ywcMax, -1.0, 1.0);
 
     // Update global width/height for coordinate conversion
     winWidth = newWidth;
@@ -666,8 +879,83 @@ void init(void) {
     glClearColor(1.0, 1.0, 1.0, 0.0);
 }
 
+// Print command-line usage
+void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s [--stress N | --stress-file FILE] [--csv FILE] [--frames N]\n"
+            "       %s --replay TRACE [--segment I]\n"
+            "  --stress N         clip and draw N random segments every frame\n"
+            "  --stress-file FILE clip and draw the segments of a segment file\n"
+            "  --csv FILE         per-frame timing log (default stress_frames.csv)\n"
+            "  --frames N         exit after N frames\n"
+            "  --replay TRACE     animate segments from a clipTraceGen trace\n"
+            "  --segment I        trace segment to show first (default 0)\n", prog, prog);
+}
+
 int main(int argc, char **argv) {
     glutInit(&argc, argv);
+
+    // Parse our own options; glutInit has already removed its own
+    unsigned long numStressSegs = 0;
+    const char *stressPath = nullptr;
+    const char *csvPath = "stress_frames.csv";
+    const char *replayPath = nullptr;
+    uint64_t firstReplaySeg = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--stress") && i + 1 < argc) {
+            numStressSegs = strtoul(argv[++i], nullptr, 10);
+            stressMode = true;
+        } else if (!strcmp(argv[i], "--stress-file") && i + 1 < argc) {
+            stressPath = argv[++i];
+            stressMode = true;
+        } else if (!strcmp(argv[i], "--csv") && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            stressFrameLimit = strtol(argv[++i], nullptr, 10);
+        } else if (!strcmp(argv[i], "--replay") && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (!strcmp(argv[i], "--segment") && i + 1 < argc) {
+            firstReplaySeg = strtoull(argv[++i], nullptr, 10);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (replayPath) {
+        if (stressMode) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (!replayTrace.open(replayPath) || replayTrace.numSegs() == 0) {
+            fprintf(stderr, "Cannot open clip trace %s\n", replayPath);
+            return 1;
+        }
+        if (firstReplaySeg >= replayTrace.numSegs()) {
+            fprintf(stderr, "Segment %llu is not in the trace\n", (unsigned long long)firstReplaySeg);
+            return 1;
+        }
+        selectReplaySeg(firstReplaySeg);
+    }
+
+    if (stressMode) {
+        if (stressPath) {
+            if (!stressFile.open(stressPath)) {
+                fprintf(stderr, "Cannot open segment file %s\n", stressPath);
+                return 1;
+            }
+        } else {
+            generateRandomSegs(stressSegs, numStressSegs, {xwcMin, ywcMin}, {xwcMax, ywcMax});
+        }
+
+        stressLog = fopen(csvPath, "w");
+        if (!stressLog) {
+            fprintf(stderr, "Cannot write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(stressLog, "frame,segments,visible,clip_ms,draw_ms,swap_ms\n");
+    }
+
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB); // Use double buffering
     glutInitWindowPosition(50, 50);
     glutInitWindowSize(winWidth, winHeight);
@@ -681,6 +969,9 @@ int main(int argc, char **argv) {
     glutMouseFunc(mouseFcn);
     glutMotionFunc(motionFcn);
     glutKeyboardFunc(keyboardFcn);
+    if (stressMode) {
+        glutIdleFunc(stressIdleFcn);
+    }
 
     glutMainLoop();
     return 0;
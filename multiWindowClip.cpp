@@ -0,0 +1,73 @@
+#include "multiWindowClip.h"
+
+// Clip one block against a single window, appending the survivors to out
+static size_t clipBlock(const wcSeg2D *segs, size_t count, const wcWindow2D &win,
+                        BlockClass cls, std::vector<wcSeg2D> &out) {
+    if (cls == BlockClass::ACCEPT) {
+        out.insert(out.end(), segs, segs + count);
+        return count;
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        wcSeg2D seg = segs[i];
+        if (lineClipCohSuth(win.winMin, win.winMax, &seg.p1, &seg.p2)) {
+            out.push_back(seg);
+            kept++;
+        }
+    }
+    return kept;
+}
+
+// Size out to one stream per window and empty each, keeping its capacity
+static void resetOutputs(std::vector<std::vector<wcSeg2D> > &out, size_t numWins) {
+    out.resize(numWins);
+    for (size_t k = 0; k < numWins; k++)
+        out[k].clear();
+}
+
+size_t clipSegsMultiWindow(const wcSeg2D *segs, size_t numSegs,
+                           const wcWindow2D *wins, size_t numWins,
+                           std::vector<std::vector<wcSeg2D> > &out) {
+    resetOutputs(out, numWins);
+    size_t kept = 0;
+
+    for (size_t first = 0; first < numSegs; first += clipBlockSegs) {
+        size_t count = numSegs - first < clipBlockSegs ? numSegs - first : clipBlockSegs;
+
+        // Bound the block once; this pass loads it into cache
+        segBlockHeader blk;
+        blk.bbMin = blk.bbMax = segs[first].p1;
+        blk.count = uint32_t(count);
+        for (size_t i = first; i < first + count; i++) {
+            growBlockBox(&blk, segs[i].p1);
+            growBlockBox(&blk, segs[i].p2);
+        }
+
+        // Classify and clip the still-hot block against every window
+        for (size_t k = 0; k < numWins; k++) {
+            BlockClass cls = classifyBlock(blk, wins[k].winMin, wins[k].winMax);
+            if (cls != BlockClass::REJECT)
+                kept += clipBlock(segs + first, count, wins[k], cls, out[k]);
+        }
+    }
+    return kept;
+}
+
+size_t clipSegmentFileMultiWindow(const SegmentFile &file,
+                                  const wcWindow2D *wins, size_t numWins,
+                                  std::vector<std::vector<wcSeg2D> > &out) {
+    resetOutputs(out, numWins);
+    size_t kept = 0;
+
+    for (uint32_t b = 0; b < file.numBlocks(); b++) {
+        const segBlockHeader &blk = file.blockHeader(b);
+
+        for (size_t k = 0; k < numWins; k++) {
+            BlockClass cls = classifyBlock(blk, wins[k].winMin, wins[k].winMax);
+            if (cls != BlockClass::REJECT)
+                kept += clipBlock(file.blockSegs(b), blk.count, wins[k], cls, out[k]);
+        }
+    }
+    return kept;
+}
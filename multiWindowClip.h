@@ -0,0 +1,37 @@
+#ifndef MULTI_WINDOW_CLIP_H
+#define MULTI_WINDOW_CLIP_H
+
+#include <cstddef>
+#include <vector>
+#include "segmentFile.h"
+
+// An axis-aligned clipping window
+class wcWindow2D {
+public:
+    wcPt2D winMin, winMax;
+};
+
+// Segments per pass: 2048 * 16 bytes = 32 KiB, small enough to stay in cache
+// while the block is clipped against every window
+const size_t clipBlockSegs = 2048;
+
+/*
+ * Clip one segment set against numWins windows in a single pass over memory.
+ * Segments are processed a cache-sized block at a time; each block's bounding
+ * box is classified against all windows, and the block is skipped, copied or
+ * clipped per window before moving on. out is resized to numWins and
+ * out[k] is cleared (keeping its capacity, so out can be reused from frame
+ * to frame) and receives the segments clipped to wins[k], in input order.
+ * Returns the total number of segments written across all windows.
+ */
+size_t clipSegsMultiWindow(const wcSeg2D *segs, size_t numSegs,
+                           const wcWindow2D *wins, size_t numWins,
+                           std::vector<std::vector<wcSeg2D> > &out);
+
+// Same, reading from a segment file; blocks whose zone-map bounding box is
+// rejected by every window are skipped without touching their pages
+size_t clipSegmentFileMultiWindow(const SegmentFile &file,
+                                  const wcWindow2D *wins, size_t numWins,
+                                  std::vector<std::vector<wcSeg2D> > &out);
+
+#endif // MULTI_WINDOW_CLIP_H
@@ -0,0 +1,85 @@
+#include <random>
+#include <vector>
+#include <cstdio>
+#include "multiWindowClip.h"
+
+// Compare two clipped segments bit for bit
+static bool sameSeg(const wcSeg2D &a, const wcSeg2D &b) {
+    return a.p1.x == b.p1.x && a.p1.y == b.p1.y && a.p2.x == b.p2.x && a.p2.y == b.p2.y;
+}
+
+// Check that out holds exactly the per-window lineClipCohSuth results
+static bool matchesReference(const char *name, const std::vector<std::vector<wcSeg2D> > &out,
+                             const std::vector<std::vector<wcSeg2D> > &ref) {
+    bool ok = out.size() == ref.size();
+    for (size_t k = 0; ok && k < ref.size(); k++) {
+        ok = out[k].size() == ref[k].size();
+        for (size_t i = 0; ok && i < ref[k].size(); i++)
+            ok = sameSeg(out[k][i], ref[k][i]);
+        if (!ok) fprintf(stderr, "%s: window %lu differs from lineClipCohSuth\n", name, (unsigned long)k);
+    }
+    return ok;
+}
+
+/*
+ * Headless check that both multi-window clippers produce, for every window,
+ * the same segments in the same order as clipping that window on its own.
+ * argv[1] is a scratch path for the segment file.
+ */
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s SCRATCH_SEGMENT_FILE\n", argv[0]);
+        return 1;
+    }
+
+    // Short segments clustered so blocks are spatially coherent, giving a mix
+    // of rejected, accepted and partial blocks
+    std::mt19937 rng(28);
+    std::uniform_real_distribution<GLfloat> posDist(0.0f, 40.0f), dDist(-5.0f, 5.0f);
+    std::vector<wcSeg2D> segs(200000);
+    for (size_t i = 0; i < segs.size(); i++) {
+        GLfloat cx = GLfloat((i / 4096) % 10) * 50.0f, cy = GLfloat((i / 40960) % 10) * 50.0f;
+        segs[i].p1 = {cx + posDist(rng), cy + posDist(rng)};
+        segs[i].p2 = {segs[i].p1.x + dDist(rng), segs[i].p1.y + dDist(rng)};
+    }
+
+    std::vector<wcWindow2D> wins;
+    wins.push_back({{-10.0f, -10.0f}, {510.0f, 510.0f}});     // Contains everything
+    wins.push_back({{1000.0f, 1000.0f}, {1100.0f, 1100.0f}}); // Contains nothing
+    for (int k = 0; k < 30; k++) {
+        GLfloat x = GLfloat(k) * 15.0f;
+        wins.push_back({{x, x / 2}, {x + 60.0f, x / 2 + 45.0f}});
+    }
+
+    std::vector<std::vector<wcSeg2D> > ref(wins.size());
+    size_t refKept = 0;
+    for (size_t k = 0; k < wins.size(); k++) {
+        for (size_t i = 0; i < segs.size(); i++) {
+            wcSeg2D seg = segs[i];
+            if (lineClipCohSuth(wins[k].winMin, wins[k].winMax, &seg.p1, &seg.p2)) {
+                ref[k].push_back(seg);
+                refKept++;
+            }
+        }
+    }
+
+    // Start from stale streams, as a caller reusing out across frames would
+    std::vector<std::vector<wcSeg2D> > out(2, std::vector<wcSeg2D>(3, segs[0]));
+    bool ok = clipSegsMultiWindow(segs.data(), segs.size(), wins.data(), wins.size(), out) == refKept &&
+              matchesReference("clipSegsMultiWindow", out, ref);
+
+    SegmentFile file;
+    if (!writeSegmentFile(argv[1], segs.data(), segs.size()) || !file.open(argv[1])) {
+        fprintf(stderr, "Cannot write and reopen %s\n", argv[1]);
+        return 1;
+    }
+    // out is deliberately reused: results from the first call must not leak in
+    ok = clipSegmentFileMultiWindow(file, wins.data(), wins.size(), out) == refKept &&
+         matchesReference("clipSegmentFileMultiWindow", out, ref) && ok;
+    file.close();
+    remove(argv[1]);
+
+    printf("%s: %lu segments, %lu windows, %lu clipped\n", ok ? "OK" : "FAILED",
+           (unsigned long)segs.size(), (unsigned long)wins.size(), (unsigned long)refKept);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "segmentFile.h"
+
+// Round a byte count up to a whole number of pages
+static size_t pageAlign(size_t bytes) {
+    return (bytes + segPageSize - 1) / segPageSize * segPageSize;
+}
+
+static size_t zoneMapBytes(uint32_t numBlocks) {
+    return pageAlign(size_t(numBlocks) * sizeof(segBlockHeader));
+}
+
+// Writing
+
+// Write count bytes of zeros to pad the current section out to a page boundary
+static bool writePadding(FILE *fp, size_t count) {
+    static const char zeros[segPageSize] = {0};
+    return count == 0 || fwrite(zeros, 1, count, fp) == count;
+}
+
+// Extend a block's bounding box to cover pt
+void growBlockBox(segBlockHeader *blk, wcPt2D pt) {
+    if (pt.x < blk->bbMin.x) blk->bbMin.x = pt.x;
+    if (pt.x > blk->bbMax.x) blk->bbMax.x = pt.x;
+    if (pt.y < blk->bbMin.y) blk->bbMin.y = pt.y;
+    if (pt.y > blk->bbMax.y) blk->bbMax.y = pt.y;
+}
+
+bool writeSegmentFile(const char *path, const wcSeg2D *segs, uint64_t numSegs) {
+    uint32_t numBlocks = uint32_t((numSegs + segBlockSegs - 1) / segBlockSegs);
+
+    // Build the zone map up front so it can precede the segment data
+    std::vector<segBlockHeader> zoneMap(numBlocks);
+    for (uint32_t b = 0; b < numBlocks; b++) {
+        uint64_t first = uint64_t(b) * segBlockSegs;
+        segBlockHeader &blk = zoneMap[b];
+        blk.count = uint32_t(numSegs - first < segBlockSegs ? numSegs - first : segBlockSegs);
+        blk.bbMin = blk.bbMax = segs[first].p1;
+        for (uint32_t i = 0; i < blk.count; i++) {
+            growBlockBox(&blk, segs[first + i].p1);
+            growBlockBox(&blk, segs[first + i].p2);
+        }
+    }
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    segFileHeader header = {segFileMagic, segFileVersion, segBlockSegs, numBlocks, numSegs};
+    size_t mapBytes = size_t(numBlocks) * sizeof(segBlockHeader);
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              writePadding(fp, segPageSize - sizeof(header)) &&
+              (numBlocks == 0 || fwrite(zoneMap.data(), sizeof(segBlockHeader), numBlocks, fp) == numBlocks) &&
+              writePadding(fp, zoneMapBytes(numBlocks) - mapBytes);
+
+    // Data blocks; only the last one can be short, so pad it to a full page
+    for (uint32_t b = 0; ok && b < numBlocks; b++) {
+        uint32_t count = zoneMap[b].count;
+        ok = fwrite(segs + uint64_t(b) * segBlockSegs, sizeof(wcSeg2D), count, fp) == count &&
+             writePadding(fp, (segBlockSegs - count) * sizeof(wcSeg2D));
+    }
+
+    if (fclose(fp) != 0) ok = false;
+    return ok;
+}
+
+// Spread the low 16 bits of v to the even bit positions
+static uint32_t spreadBits(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+void sortSegsSpatially(std::vector<wcSeg2D> &segs) {
+    if (segs.empty()) return;
+
+    // Quantize midpoints to a 16-bit grid over the bounding box of all segments
+    segBlockHeader world;
+    world.bbMin = world.bbMax = segs[0].p1;
+    for (size_t i = 0; i < segs.size(); i++) {
+        growBlockBox(&world, segs[i].p1);
+        growBlockBox(&world, segs[i].p2);
+    }
+    GLfloat width = world.bbMax.x - world.bbMin.x, height = world.bbMax.y - world.bbMin.y;
+    GLfloat xScale = width > 0 ? 65535.0f / width : 0.0f;
+    GLfloat yScale = height > 0 ? 65535.0f / height : 0.0f;
+
+    struct keyedSeg {
+        uint32_t key;
+        wcSeg2D seg;
+    };
+    std::vector<keyedSeg> keyed(segs.size());
+    for (size_t i = 0; i < segs.size(); i++) {
+        GLfloat mx = (segs[i].p1.x + segs[i].p2.x) / 2, my = (segs[i].p1.y + segs[i].p2.y) / 2;
+        uint32_t qx = std::min(uint32_t((mx - world.bbMin.x) * xScale), uint32_t(65535));
+        uint32_t qy = std::min(uint32_t((my - world.bbMin.y) * yScale), uint32_t(65535));
+        keyed[i].key = spreadBits(qx) | (spreadBits(qy) << 1);
+        keyed[i].seg = segs[i];
+    }
+
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const keyedSeg &a, const keyedSeg &b) { return a.key < b.key; });
+    for (size_t i = 0; i < segs.size(); i++)
+        segs[i] = keyed[i].seg;
+}
+
+void generateRandomSegs(std::vector<wcSeg2D> &segs, size_t numSegs,
+                        wcPt2D worldMin, wcPt2D worldMax) {
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<GLfloat> xDist(worldMin.x, worldMax.x), yDist(worldMin.y, worldMax.y);
+    std::uniform_real_distribution<GLfloat> dDist(-20.0f, 20.0f);
+
+    segs.resize(numSegs);
+    for (size_t i = 0; i < numSegs; i++) {
+        wcSeg2D &seg = segs[i];
+        seg.p1 = {xDist(rng), yDist(rng)};
+        seg.p2 = {seg.p1.x + dDist(rng), seg.p1.y + dDist(rng)};
+    }
+}
+
+// Reading
+
+SegmentFile::SegmentFile()
+    : header(nullptr), zoneMap(nullptr), segData(nullptr) {}
+
+SegmentFile::~SegmentFile() {
+    close();
+}
+
+bool SegmentFile::open(const char *path) {
+    close();
+    if (!map.open(path)) return false;
+    if (map.size() < segPageSize) {
+        close();
+        return false;
+    }
+
+    const char *base = map.data();
+    size_t mapSize = map.size();
+    const segFileHeader *hdr = reinterpret_cast<const segFileHeader *>(base);
+
+    // Validate the header and that every block the zone map names is present.
+    // Sizes are computed in 64 bits so a bogus numBlocks cannot wrap size_t.
+    uint64_t zoneBytes = (uint64_t(hdr->numBlocks) * sizeof(segBlockHeader) + segPageSize - 1) /
+                         segPageSize * segPageSize;
+    uint64_t dataOffset = segPageSize + zoneBytes;
+    if (hdr->magic != segFileMagic || hdr->version != segFileVersion ||
+        hdr->blockSegs != segBlockSegs ||
+        uint64_t(hdr->numBlocks) * segBlockSegs < hdr->numSegs ||
+        dataOffset + uint64_t(hdr->numBlocks) * segPageSize > mapSize) {
+        close();
+        return false;
+    }
+
+    // Readers trust each block's count, so check the zone map adds up
+    const segBlockHeader *blocks = reinterpret_cast<const segBlockHeader *>(base + segPageSize);
+    uint64_t total = 0;
+    for (uint32_t b = 0; b < hdr->numBlocks; b++) {
+        if (blocks[b].count > segBlockSegs) {
+            close();
+            return false;
+        }
+        total += blocks[b].count;
+    }
+    if (total != hdr->numSegs) {
+        close();
+        return false;
+    }
+
+    // The zone map is always scanned front to back, while blocks are visited
+    // selectively and read-ahead would only fault in rejected ones
+    map.adviseSequential(0, size_t(dataOffset));
+    map.adviseRandom(size_t(dataOffset), mapSize - size_t(dataOffset));
+
+    header = hdr;
+    zoneMap = blocks;
+    segData = reinterpret_cast<const wcSeg2D *>(base + size_t(dataOffset));
+    return true;
+}
+
+void SegmentFile::close() {
+    map.close();
+    header = nullptr;
+    zoneMap = nullptr;
+    segData = nullptr;
+}
+
+// Clipping
+
+BlockClass classifyBlock(const segBlockHeader &blk, wcPt2D winMin, wcPt2D winMax) {
+    // The box's diagonal corners share an outside bit only if the whole box
+    // does, and are both inside only if the whole box is inside
+    GLubyte code1 = encode(blk.bbMin, winMin, winMax);
+    GLubyte code2 = encode(blk.bbMax, winMin, winMax);
+
+    if (reject(code1, code2)) return BlockClass::REJECT;
+    if (accept(code1, code2)) return BlockClass::ACCEPT;
+    return BlockClass::PARTIAL;
+}
+
+uint64_t clipSegmentFile(const SegmentFile &file, wcPt2D winMin, wcPt2D winMax,
+                         segVisitFcn visit, void *userData) {
+    uint64_t kept = 0;
+
+    for (uint32_t b = 0; b < file.numBlocks(); b++) {
+        const segBlockHeader &blk = file.blockHeader(b);
+        BlockClass cls = classifyBlock(blk, winMin, winMax);
+        if (cls == BlockClass::REJECT) continue; // Segment pages are never touched
+
+        const wcSeg2D *segs = file.blockSegs(b);
+        for (uint32_t i = 0; i < blk.count; i++) {
+            wcSeg2D seg = segs[i];
+            if (cls == BlockClass::ACCEPT || lineClipCohSuth(winMin, winMax, &seg.p1, &seg.p2)) {
+                visit(seg, userData);
+                kept++;
+            }
+        }
+    }
+    return kept;
+}
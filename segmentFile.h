@@ -0,0 +1,105 @@
+#ifndef SEGMENT_FILE_H
+#define SEGMENT_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ch8CohenSutherlandLineClip2D.h"
+#include "mappedFile.h"
+
+// A line segment as stored on disk
+class wcSeg2D {
+public:
+    wcPt2D p1, p2;
+};
+
+/*
+ * Block-structured segment file. Every section starts on a page boundary:
+ *
+ *   segFileHeader                     (padded to one page)
+ *   zone map: numBlocks segBlockHeader (padded to whole pages)
+ *   numBlocks data blocks              (segBlockSegs segments = one page each)
+ *
+ * The zone map keeps the bounding box of every block apart from the segment
+ * data, so a reader can reject whole blocks without faulting their pages in.
+ * Pages are 16 KiB, the largest VM page we target (Apple Silicon); on 4 KiB
+ * systems a block spans four pages and still never shares one with another.
+ * Blocks are only spatially tight if the segments are written in spatial
+ * order, see sortSegsSpatially().
+ */
+const uint32_t segFileMagic = 0x47455343;   // "CSEG" in little-endian order
+const uint32_t segFileVersion = 2;
+const size_t segPageSize = 16384;
+const uint32_t segBlockSegs = segPageSize / sizeof(wcSeg2D);
+
+struct segFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blockSegs;     // Segments per full block
+    uint32_t numBlocks;
+    uint64_t numSegs;
+};
+
+// Zone map entry: bounding box and segment count of one data block
+struct segBlockHeader {
+    wcPt2D bbMin, bbMax;
+    uint32_t count;
+};
+
+// Result of applying the outcode test to a block's bounding box
+enum class BlockClass { REJECT, ACCEPT, PARTIAL };
+
+// Read-only, memory-mapped view of a segment file
+class SegmentFile {
+public:
+    SegmentFile();
+    ~SegmentFile();
+
+    bool open(const char *path);
+    void close();
+
+    uint64_t numSegs() const { return header ? header->numSegs : 0; }
+    uint32_t numBlocks() const { return header ? header->numBlocks : 0; }
+    const segBlockHeader &blockHeader(uint32_t i) const { return zoneMap[i]; }
+    const wcSeg2D *blockSegs(uint32_t i) const { return segData + size_t(i) * segBlockSegs; }
+
+private:
+    SegmentFile(const SegmentFile &) = delete;
+    SegmentFile &operator=(const SegmentFile &) = delete;
+
+    MappedFile map;
+    const segFileHeader *header;
+    const segBlockHeader *zoneMap;
+    const wcSeg2D *segData;
+};
+
+// Callback receiving each clipped segment that survives
+typedef void (*segVisitFcn)(wcSeg2D seg, void *userData);
+
+// Extend a block's bounding box to cover pt
+void growBlockBox(segBlockHeader *blk, wcPt2D pt);
+
+// Fill segs with numSegs short random segments (up to 20 units per axis)
+// starting inside worldMin-worldMax. The seed is fixed so runs are comparable.
+void generateRandomSegs(std::vector<wcSeg2D> &segs, size_t numSegs,
+                        wcPt2D worldMin, wcPt2D worldMax);
+
+// Reorder segs along a Morton (Z-order) curve of their midpoints, so that
+// consecutive segments - and hence each block - cover a small area
+void sortSegsSpatially(std::vector<wcSeg2D> &segs);
+
+// Write segs to path in the block format, in the order given (sort them with
+// sortSegsSpatially() first unless they are already spatially coherent);
+// returns false on I/O failure
+bool writeSegmentFile(const char *path, const wcSeg2D *segs, uint64_t numSegs);
+
+// Trivially accept/reject a whole block using encode() on its bounding box
+BlockClass classifyBlock(const segBlockHeader &blk, wcPt2D winMin, wcPt2D winMax);
+
+// Clip every segment of the file against the window, skipping rejected blocks
+// entirely and passing accepted blocks through without per-segment encoding.
+// Returns the number of segments handed to visit.
+uint64_t clipSegmentFile(const SegmentFile &file, wcPt2D winMin, wcPt2D winMax,
+                         segVisitFcn visit, void *userData);
+
+#endif // SEGMENT_FILE_H
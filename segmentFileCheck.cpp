@@ -0,0 +1,131 @@
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include "segmentFile.h"
+
+// Collects the segments clipSegmentFile hands out
+static void collectSeg(wcSeg2D seg, void *userData) {
+    static_cast<std::vector<wcSeg2D> *>(userData)->push_back(seg);
+}
+
+// Compare two clipped segments bit for bit
+static bool sameSeg(const wcSeg2D &a, const wcSeg2D &b) {
+    return a.p1.x == b.p1.x && a.p1.y == b.p1.y && a.p2.x == b.p2.x && a.p2.y == b.p2.y;
+}
+
+// Read a whole file into bytes
+static std::vector<char> readBytes(const char *path) {
+    std::vector<char> bytes;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) return bytes;
+    char buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        bytes.insert(bytes.end(), buf, buf + n);
+    fclose(fp);
+    return bytes;
+}
+
+// Write bytes to path and report whether SegmentFile accepts the result
+static bool opensAfterWrite(const std::string &path, const std::vector<char> &bytes) {
+    FILE *fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    fwrite(bytes.data(), 1, bytes.size(), fp);
+    fclose(fp);
+
+    SegmentFile file;
+    bool opened = file.open(path.c_str());
+    remove(path.c_str());
+    return opened;
+}
+
+// Report a failed check and pass its result through
+static bool check(bool ok, const char *what) {
+    if (!ok) fprintf(stderr, "FAILED: %s\n", what);
+    return ok;
+}
+
+/*
+ * Headless check of the segment file: clipSegmentFile() must match
+ * lineClipCohSuth() segment for segment, spatial sorting must let small
+ * windows reject most blocks, and open() must refuse damaged files.
+ * argv[1] is a scratch path prefix.
+ */
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s SCRATCH_PATH\n", argv[0]);
+        return 1;
+    }
+    std::string path = argv[1];
+    bool ok = true;
+
+    std::vector<wcSeg2D> segs;
+    generateRandomSegs(segs, 300000, {0.0f, 0.0f}, {1000.0f, 1000.0f});
+    sortSegsSpatially(segs);
+    ok = check(writeSegmentFile(path.c_str(), segs.data(), segs.size()), "write segment file") && ok;
+
+    SegmentFile file;
+    ok = check(file.open(path.c_str()), "open segment file") && ok;
+    ok = check(file.numSegs() == segs.size(), "segment count") && ok;
+
+    // Small, medium and all-covering windows against the reference clipper
+    const wcPt2D wins[][2] = {{{100.0f, 100.0f}, {150.0f, 130.0f}},
+                              {{200.0f, 300.0f}, {700.0f, 650.0f}},
+                              {{-50.0f, -50.0f}, {1050.0f, 1050.0f}}};
+    for (size_t w = 0; w < sizeof(wins) / sizeof(wins[0]); w++) {
+        std::vector<wcSeg2D> ref, out;
+        for (size_t i = 0; i < segs.size(); i++) {
+            wcSeg2D seg = segs[i];
+            if (lineClipCohSuth(wins[w][0], wins[w][1], &seg.p1, &seg.p2))
+                ref.push_back(seg);
+        }
+        bool same = clipSegmentFile(file, wins[w][0], wins[w][1], collectSeg, &out) == ref.size() &&
+                    out.size() == ref.size();
+        for (size_t i = 0; same && i < ref.size(); i++)
+            same = sameSeg(out[i], ref[i]);
+        ok = check(same, "clipSegmentFile matches lineClipCohSuth") && ok;
+    }
+
+    // With spatially sorted input a small window must skip most blocks
+    uint32_t rejected = 0, numBlocks = file.numBlocks();
+    for (uint32_t b = 0; b < numBlocks; b++)
+        rejected += classifyBlock(file.blockHeader(b), wins[0][0], wins[0][1]) == BlockClass::REJECT;
+    ok = check(rejected * 10 >= numBlocks * 9, "small window rejects most blocks") && ok;
+    file.close();
+
+    // Damaged copies of the file must be refused
+    std::vector<char> bytes = readBytes(path.c_str());
+    const size_t countOffset = segPageSize + offsetof(segBlockHeader, count);
+    std::string bad = path + ".bad";
+
+    std::vector<char> damaged = bytes;
+    uint32_t count = segBlockSegs + 1;
+    memcpy(&damaged[countOffset], &count, sizeof(count));
+    ok = check(!opensAfterWrite(bad, damaged), "refuse block count above segBlockSegs") && ok;
+
+    damaged = bytes;
+    count = segBlockSegs - 1;
+    memcpy(&damaged[countOffset], &count, sizeof(count));
+    ok = check(!opensAfterWrite(bad, damaged), "refuse counts not adding up to numSegs") && ok;
+
+    damaged.assign(bytes.begin(), bytes.end() - segPageSize);
+    ok = check(!opensAfterWrite(bad, damaged), "refuse truncated data section") && ok;
+
+    ok = check(opensAfterWrite(bad, bytes), "reopen undamaged copy") && ok;
+    remove(path.c_str());
+
+    // An empty file is valid and clips to nothing
+    std::vector<wcSeg2D> none;
+    ok = check(writeSegmentFile(path.c_str(), none.data(), 0) && file.open(path.c_str()) &&
+               file.numSegs() == 0 && file.numBlocks() == 0 &&
+               clipSegmentFile(file, wins[2][0], wins[2][1], collectSeg, &none) == 0,
+               "empty segment file") && ok;
+    file.close();
+    remove(path.c_str());
+
+    printf("%s: %lu segments, %u of %u blocks rejected by the small window\n", ok ? "OK" : "FAILED",
+           (unsigned long)segs.size(), rejected, numBlocks);
+    return ok ? 0 : 1;
+}